@@ -1,4 +1,7 @@
 #include "CustomStackSize.h"
+#include "CustomStackSizeRegistrySync.h"
+#include "CustomStackSizeRegistry.h"
+#include "CustomStackSizeLog.h"
 #include "Modules/ModuleManager.h"
 #include "FGItemDescriptor.h"
 #include "FGRecipe.h"
@@ -11,16 +14,27 @@
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "AssetRegistry/AssetData.h"
 #include "Engine/World.h"
+#include "Misc/ScopeLock.h"
+#include "GameFramework/GameModeBase.h"
+#include "FGPlayerController.h"
 #include "LargeFluidOutputBuffersConfigurationStruct.h"
 #include "Configuration/ConfigProperty.h"
 
-DEFINE_LOG_CATEGORY_STATIC(LogCustomStackSize, Log, All);
+DEFINE_LOG_CATEGORY(LogCustomStackSize);
 
 #define LOCTEXT_NAMESPACE "FCustomStackSizeModule"
 
-// Global registry for custom stack Size
-static TMap<UClass*, int32> GCustomStackSize;
-static TMap<UClass*, EResourceForm> GCustomResourceForms;
+// Global registry for custom stack Size; read from worker threads by the GetStackSize hook
+static FCustomStackSizeRegistry GCustomStackSize;
+
+// Forms the CDOs had before we overrode them, so the vanilla baseline survives registration
+static TMap<UClass*, EResourceForm> GVanillaResourceForms;
+
+// Registrations made on this machine. While connected as a client the active registry is the server's;
+// these are kept here and restored when the client leaves the server (disconnect or travel).
+static TMap<UClass*, FCustomStackSizeRecord> GLocalStackSizes;
+static bool bServerRegistryActive = false;
+static FCriticalSection GLocalStackSizesLock;
 
 static FNativeFuncPtr OriginalGetStackSizeNative = nullptr;
 static UFunction* GetStackSizeFunction = nullptr;
@@ -174,6 +188,25 @@ void FCustomStackSizeModule::StartupModule()
 			UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Engine loop init complete, initializing hooks..."));
 			InitHooks();
 
+			// Server -> client registry sync; the RCO is created for every player controller
+			AFGPlayerController::RegisterRemoteCallObjectClass(UCustomStackSizeRegistrySync::StaticClass());
+
+			PostLoginHandle = FGameModeEvents::GameModePostLoginEvent.AddLambda(
+				[](AGameModeBase* GameMode, APlayerController* NewPlayer)
+				{
+					UCustomStackSizeRegistrySync::EnableHandshakeForPlayer(NewPlayer);
+				});
+
+			// Leaving a server (disconnect or travel) puts this machine's own registrations back
+			WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddLambda(
+				[](UWorld* World, bool bSessionEnded, bool bCleanupResources)
+				{
+					if (World && World->IsGameWorld() && World->GetNetMode() == NM_Client)
+					{
+						RestoreLocalStackSizes();
+					}
+				});
+
 			WorldInitHandle = FWorldDelegates::OnWorldTickStart.AddLambda(
 				[this](UWorld* World, ELevelTick TickType, float DeltaTime)
 				{
@@ -355,13 +388,77 @@ void FCustomStackSizeModule::ShutdownModule()
 		WorldTickHandle.Reset();
 	}
 
+	if (PostLoginHandle.IsValid())
+	{
+		FGameModeEvents::GameModePostLoginEvent.Remove(PostLoginHandle);
+		PostLoginHandle.Reset();
+	}
+
+	if (WorldCleanupHandle.IsValid())
+	{
+		FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+		WorldCleanupHandle.Reset();
+	}
+
 	// Clear global maps
-	GCustomStackSize.Empty();
-	GCustomResourceForms.Empty();
+	GCustomStackSize.Reset();
+	GVanillaResourceForms.Empty();
+	GLocalStackSizes.Empty();
+	bServerRegistryActive = false;
 
 	UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Module shutdown complete"));
 }
 
+// Default game mapping of EStackSize to item count
+static int32 StackSizeFromEnumValue(int64 EnumValue)
+{
+	switch (EnumValue)
+	{
+	case 0: return 1;      // SS_ONE
+	case 1: return 50;     // SS_SMALL
+	case 2: return 100;    // SS_MEDIUM
+	case 3: return 200;    // SS_BIG
+	case 4: return 500;    // SS_HUGE
+	case 5: return 50000;  // SS_FLUID
+	default: return 1;
+	}
+}
+
+// Reads mStackSize from a descriptor (instance or CDO) and maps it to the vanilla item count
+static bool ReadVanillaStackSize(UObject* Container, UClass* ItemClass, int32& OutStackSize)
+{
+	if (!Container || !ItemClass)
+		return false;
+
+	FEnumProperty* EnumProp = CastField<FEnumProperty>(ItemClass->FindPropertyByName(TEXT("mStackSize")));
+	if (!EnumProp)
+		return false;
+
+	void* PropPtr = EnumProp->ContainerPtrToValuePtr<void>(Container);
+	FNumericProperty* UnderlyingProp = EnumProp->GetUnderlyingProperty();
+	if (!PropPtr || !UnderlyingProp)
+		return false;
+
+	OutStackSize = StackSizeFromEnumValue(UnderlyingProp->GetSignedIntPropertyValue(PropPtr));
+	return true;
+}
+
+bool FindHookedStackSize(const FCustomStackSizeRegistry& Registry, UObject* Context, UClass* ItemClass, FCustomStackSizeRecord& OutRecord)
+{
+	UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] GetStackSize called on: %s"),
+		Context ? *Context->GetClass()->GetName() : TEXT("NULL"));
+
+	if (ItemClass && Registry.Find(ItemClass, OutRecord))
+	{
+		UE_LOG(LogCustomStackSize, Warning, TEXT("[CustomStackSize] >>> RETURNING CUSTOM STACK SIZE %d for %s <<<"),
+			OutRecord.StackSize, *ItemClass->GetName());
+		return true;
+	}
+
+	UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] No custom size found, calling original"));
+	return false;
+}
+
 // Custom GetStackSize implementation
 void CustomGetStackSize_Native(UObject* Context, FFrame& Stack, void* const Z_Param__Result)
 {
@@ -372,9 +469,6 @@ void CustomGetStackSize_Native(UObject* Context, FFrame& Stack, void* const Z_Pa
 		return;
 	}
 
-	UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] GetStackSize called on: %s"),
-		Context ? *Context->GetClass()->GetName() : TEXT("NULL"));
-
 	UClass* ItemClass = nullptr;
 
 	if (Context)
@@ -395,20 +489,13 @@ void CustomGetStackSize_Native(UObject* Context, FFrame& Stack, void* const Z_Pa
 		ItemClass = InItemClass;
 	}
 
-	if (ItemClass && GCustomStackSize.Contains(ItemClass))
+	FCustomStackSizeRecord Record;
+	if (FindHookedStackSize(GCustomStackSize, Context, ItemClass, Record))
 	{
-		int32 CustomSize = GCustomStackSize[ItemClass];
-
-		*(int32*)Z_Param__Result = CustomSize;
-
-		UE_LOG(LogCustomStackSize, Warning, TEXT("[CustomStackSize] >>> RETURNING CUSTOM STACK SIZE %d for %s <<<"),
-			CustomSize, *ItemClass->GetName());
-
+		*(int32*)Z_Param__Result = Record.StackSize;
 		return;
 	}
 
-	UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] No custom size found, calling original"));
-
 	if (OriginalGetStackSizeNative)
 	{
 		OriginalGetStackSizeNative(Context, Stack, Z_Param__Result);
@@ -419,41 +506,12 @@ void CustomGetStackSize_Native(UObject* Context, FFrame& Stack, void* const Z_Pa
 	{
 		// Fallback: calculate from enum
 		UFGItemDescriptor* Descriptor = Cast<UFGItemDescriptor>(Context);
-		if (Descriptor && ItemClass)
+		int32 StackSize = 1;
+		if (Descriptor && ItemClass && ReadVanillaStackSize(Descriptor, ItemClass, StackSize))
 		{
-			FProperty* StackSizeProp = ItemClass->FindPropertyByName(TEXT("mStackSize"));
-			if (StackSizeProp)
-			{
-				if (FEnumProperty* EnumProp = CastField<FEnumProperty>(StackSizeProp))
-				{
-					void* PropPtr = EnumProp->ContainerPtrToValuePtr<void>(Descriptor);
-					if (PropPtr)
-					{
-						FNumericProperty* UnderlyingProp = EnumProp->GetUnderlyingProperty();
-						if (UnderlyingProp)
-						{
-							int64 EnumValue = UnderlyingProp->GetSignedIntPropertyValue(PropPtr);
-
-							// Default game mappings
-							int32 StackSize = 1;
-							switch (EnumValue)
-							{
-							case 0: StackSize = 1; break;      // SS_ONE
-							case 1: StackSize = 50; break;     // SS_SMALL
-							case 2: StackSize = 100; break;    // SS_MEDIUM
-							case 3: StackSize = 200; break;    // SS_BIG
-							case 4: StackSize = 500; break;    // SS_HUGE
-							case 5: StackSize = 50000; break;  // SS_FLUID
-							default: StackSize = 1; break;
-							}
-
-							*(int32*)Z_Param__Result = StackSize;
-							UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Fallback returned: %d"), StackSize);
-							return;
-						}
-					}
-				}
-			}
+			*(int32*)Z_Param__Result = StackSize;
+			UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Fallback returned: %d"), StackSize);
+			return;
 		}
 
 		// Final fallback
@@ -540,7 +598,7 @@ void FCustomStackSizeModule::InitHooks()
 }
 
 // Static helper function to apply form changes
-static void ApplyFormToCDO(UClass* ItemClass, EResourceForm Form)
+static void ApplyFormToCDO(UClass* ItemClass, EResourceForm Form, int32 CachedStackSize)
 {
 	if (!ItemClass || !IsValid(ItemClass))
 		return;
@@ -571,6 +629,11 @@ static void ApplyFormToCDO(UClass* ItemClass, EResourceForm Form)
 				FNumericProperty* UnderlyingProp = EnumProp->GetUnderlyingProperty();
 				if (UnderlyingProp)
 				{
+					if (!GVanillaResourceForms.Contains(ItemClass))
+					{
+						GVanillaResourceForms.Add(ItemClass, (EResourceForm)UnderlyingProp->GetSignedIntPropertyValue(PropPtr));
+					}
+
 					UnderlyingProp->SetIntPropertyValue(PropPtr, (int64)Form);
 
 					UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Set form to %d for %s"),
@@ -580,20 +643,17 @@ static void ApplyFormToCDO(UClass* ItemClass, EResourceForm Form)
 		}
 	}
 
-	// Try to find and override any cached stack size value
+	// Override any cached stack size value (the vanilla size when an override is dropped)
 	FProperty* CachedStackProp = ItemClass->FindPropertyByName(TEXT("mCachedStackSize"));
 	if (CachedStackProp)
 	{
 		if (FIntProperty* IntProp = CastField<FIntProperty>(CachedStackProp))
 		{
-			if (int32* CustomSize = GCustomStackSize.Find(ItemClass))
+			void* PropPtr = IntProp->ContainerPtrToValuePtr<void>(CDO);
+			if (PropPtr)
 			{
-				void* PropPtr = IntProp->ContainerPtrToValuePtr<void>(CDO);
-				if (PropPtr)
-				{
-					IntProp->SetPropertyValue(PropPtr, *CustomSize);
-					UE_LOG(LogCustomStackSize, Warning, TEXT("[CustomStackSize] Set cached stack size to %d"), *CustomSize);
-				}
+				IntProp->SetPropertyValue(PropPtr, CachedStackSize);
+				UE_LOG(LogCustomStackSize, Warning, TEXT("[CustomStackSize] Set cached stack size to %d"), CachedStackSize);
 			}
 		}
 	}
@@ -604,6 +664,11 @@ static void ApplyFormToCDO(UClass* ItemClass, EResourceForm Form)
 	#endif
 }
 
+bool FCustomStackSizeModule::IsValidStackSize(int32 StackSize, EResourceForm Form)
+{
+	return StackSize >= 1 && Form > EResourceForm::RF_INVALID && Form < EResourceForm::RF_LAST;
+}
+
 // Public: Register a custom stack size
 void FCustomStackSizeModule::RegisterCustomStackSize(UClass* ItemClass, int32 StackSize, EResourceForm Form)
 {
@@ -613,14 +678,88 @@ void FCustomStackSizeModule::RegisterCustomStackSize(UClass* ItemClass, int32 St
 		return;
 	}
 
-	GCustomStackSize.Add(ItemClass, StackSize);
-	GCustomResourceForms.Add(ItemClass, Form);
+	if (!IsValidStackSize(StackSize, Form))
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Rejected stack size %d (Form: %d) for %s"),
+			StackSize, (int32)Form, *ItemClass->GetName());
+		return;
+	}
+
+	{
+		FScopeLock Lock(&GLocalStackSizesLock);
+
+		GLocalStackSizes.Add(ItemClass, { StackSize, Form });
+
+		// The server's registry stays authoritative until we leave; applying this now would desync us
+		if (bServerRegistryActive)
+		{
+			UE_LOG(LogCustomStackSize, Warning, TEXT("[CustomStackSize] %s registered while using the server registry, deferred until disconnect"),
+				*ItemClass->GetName());
+			return;
+		}
+
+		// Size and form are published as one record so readers never see one without the other
+		GCustomStackSize.Add(ItemClass, { StackSize, Form });
+	}
+
+	UCustomStackSizeRegistrySync::NotifyRegistryChanged();
 
 	UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Registered custom stack size: %s -> %d (Form: %d)"),
 		*ItemClass->GetName(), StackSize, (int32)Form);
 
 	// Apply form changes to CDO
-	ApplyFormToCDO(ItemClass, Form);
+	ApplyFormToCDO(ItemClass, Form, StackSize);
+}
+
+void FCustomStackSizeModule::RegisterCustomStackSizes(const TArray<FCustomStackSizeEntry>& Entries)
+{
+	FCustomStackSizeRegistry::FSnapshot Batch;
+	Batch.Reserve(Entries.Num());
+	for (const FCustomStackSizeEntry& Entry : Entries)
+	{
+		if (!Entry.ItemClass || !IsValid(Entry.ItemClass))
+		{
+			UE_LOG(LogCustomStackSize, Warning, TEXT("[CustomStackSize] Attempted to register null or invalid item class"));
+			continue;
+		}
+
+		if (!IsValidStackSize(Entry.StackSize, Entry.Form))
+		{
+			UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Rejected stack size %d (Form: %d) for %s"),
+				Entry.StackSize, (int32)Entry.Form, *Entry.ItemClass->GetName());
+			continue;
+		}
+
+		Batch.Add(Entry.ItemClass, { Entry.StackSize, Entry.Form });
+	}
+
+	if (Batch.Num() == 0)
+		return;
+
+	{
+		FScopeLock Lock(&GLocalStackSizesLock);
+
+		GLocalStackSizes.Append(Batch);
+
+		if (bServerRegistryActive)
+		{
+			UE_LOG(LogCustomStackSize, Warning, TEXT("[CustomStackSize] %d items registered while using the server registry, deferred until disconnect"),
+				Batch.Num());
+			return;
+		}
+
+		// One map copy and one publish for the whole batch
+		GCustomStackSize.Append(Batch);
+	}
+
+	UCustomStackSizeRegistrySync::NotifyRegistryChanged();
+
+	UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Registered %d custom stack sizes in one batch"), Batch.Num());
+
+	for (const TPair<UClass*, FCustomStackSizeRecord>& Pair : Batch)
+	{
+		ApplyFormToCDO(Pair.Key, Pair.Value.Form, Pair.Value.StackSize);
+	}
 }
 
 void FCustomStackSizeModule::RegisterCustomStackSize(const FString& ItemPath, int32 StackSize, EResourceForm Form)
@@ -644,13 +783,143 @@ int32 FCustomStackSizeModule::GetCustomStackSize(UClass* ItemClass)
 	if (!ItemClass || !IsValid(ItemClass))
 		return -1;
 
-	if (int32* FoundSize = GCustomStackSize.Find(ItemClass))
+	FCustomStackSizeRecord Record;
+	if (GCustomStackSize.Find(ItemClass, Record))
 	{
-		return *FoundSize;
+		return Record.StackSize;
 	}
 	return -1; // Not found
 }
 
+void FCustomStackSizeModule::GetRegisteredStackSizes(TArray<FCustomStackSizeEntry>& OutEntries)
+{
+	const FCustomStackSizeRegistry::FSnapshot Snapshot = GCustomStackSize.Copy();
+	OutEntries.Reset(Snapshot.Num());
+
+	for (const TPair<UClass*, FCustomStackSizeRecord>& Pair : Snapshot)
+	{
+		if (!Pair.Key || !IsValid(Pair.Key))
+			continue;
+
+		FCustomStackSizeEntry& Entry = OutEntries.AddDefaulted_GetRef();
+		Entry.ItemClass = Pair.Key;
+		Entry.StackSize = Pair.Value.StackSize;
+		Entry.Form = Pair.Value.Form;
+	}
+}
+
+// Swaps the active registry for Entries and brings the CDOs of added and dropped classes in line
+static void ReplaceActiveStackSizes(const TArray<FCustomStackSizeEntry>& Entries)
+{
+	// Build the whole registry first so readers switch from the old one to the new one in a single publish
+	FCustomStackSizeRegistry::FSnapshot Next;
+	Next.Reserve(Entries.Num());
+	for (const FCustomStackSizeEntry& Entry : Entries)
+	{
+		if (Entry.ItemClass && IsValid(Entry.ItemClass))
+		{
+			Next.Add(Entry.ItemClass, { Entry.StackSize, Entry.Form });
+		}
+	}
+
+	// Overrides missing from the incoming set; their CDOs go back to vanilla
+	TArray<UClass*> Stale;
+	for (const TPair<UClass*, FCustomStackSizeRecord>& Pair : GCustomStackSize.Copy())
+	{
+		if (!Next.Contains(Pair.Key))
+		{
+			Stale.Add(Pair.Key);
+		}
+	}
+
+	GCustomStackSize.Publish(CopyTemp(Next));
+
+	// CDO updates only after the publish, so cached values match what readers now see
+	for (UClass* ItemClass : Stale)
+	{
+		if (ItemClass && IsValid(ItemClass))
+		{
+			ApplyFormToCDO(ItemClass, FCustomStackSizeModule::GetVanillaResourceForm(ItemClass), FCustomStackSizeModule::GetVanillaStackSize(ItemClass));
+			UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Removed stale stack size override for %s"), *ItemClass->GetName());
+		}
+	}
+
+	for (const TPair<UClass*, FCustomStackSizeRecord>& Pair : Next)
+	{
+		ApplyFormToCDO(Pair.Key, Pair.Value.Form, Pair.Value.StackSize);
+	}
+
+	UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Replaced registry: %d overrides, %d removed"), Next.Num(), Stale.Num());
+}
+
+void FCustomStackSizeModule::BeginServerStackSizes()
+{
+	FScopeLock Lock(&GLocalStackSizesLock);
+
+	bServerRegistryActive = true;
+}
+
+void FCustomStackSizeModule::ApplyServerStackSizes(const TArray<FCustomStackSizeEntry>& Entries)
+{
+	FScopeLock Lock(&GLocalStackSizesLock);
+
+	bServerRegistryActive = true;
+	ReplaceActiveStackSizes(Entries);
+}
+
+void FCustomStackSizeModule::RestoreLocalStackSizes()
+{
+	FScopeLock Lock(&GLocalStackSizesLock);
+
+	if (!bServerRegistryActive)
+		return;
+
+	TArray<FCustomStackSizeEntry> Entries;
+	Entries.Reserve(GLocalStackSizes.Num());
+	for (const TPair<UClass*, FCustomStackSizeRecord>& Pair : GLocalStackSizes)
+	{
+		Entries.Add({ Pair.Key, Pair.Value.StackSize, Pair.Value.Form });
+	}
+
+	bServerRegistryActive = false;
+	ReplaceActiveStackSizes(Entries);
+
+	UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Left server, restored %d local registrations"), Entries.Num());
+}
+
+int32 FCustomStackSizeModule::GetVanillaStackSize(UClass* ItemClass)
+{
+	if (!ItemClass || !IsValid(ItemClass))
+		return 1;
+
+	int32 StackSize = 1;
+	ReadVanillaStackSize(ItemClass->GetDefaultObject(), ItemClass, StackSize);
+	return StackSize;
+}
+
+EResourceForm FCustomStackSizeModule::GetVanillaResourceForm(UClass* ItemClass)
+{
+	if (!ItemClass || !IsValid(ItemClass))
+		return EResourceForm::RF_SOLID;
+
+	if (const EResourceForm* VanillaForm = GVanillaResourceForms.Find(ItemClass))
+	{
+		return *VanillaForm;
+	}
+
+	// Never overridden, so the CDO still holds the game value
+	if (FEnumProperty* EnumProp = CastField<FEnumProperty>(ItemClass->FindPropertyByName(TEXT("mForm"))))
+	{
+		UObject* CDO = ItemClass->GetDefaultObject();
+		FNumericProperty* UnderlyingProp = EnumProp->GetUnderlyingProperty();
+		if (CDO && UnderlyingProp)
+		{
+			return (EResourceForm)UnderlyingProp->GetSignedIntPropertyValue(EnumProp->ContainerPtrToValuePtr<void>(CDO));
+		}
+	}
+	return EResourceForm::RF_SOLID;
+}
+
 #undef LOCTEXT_NAMESPACE
 
 IMPLEMENT_MODULE(FCustomStackSizeModule, CustomStackSize)
\ No newline at end of file
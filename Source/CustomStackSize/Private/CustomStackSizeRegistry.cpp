@@ -0,0 +1,186 @@
+#include "CustomStackSizeRegistry.h"
+#include "Misc/ScopeLock.h"
+
+// ============================================================================
+// HAZARD SLOTS
+//
+// One slot per thread, shared by every registry. A reader publishes the snapshot it is about to
+// read in its own slot; writers only free retired snapshots that no slot points at.
+// Slots are pushed onto a lock-free list once and reused after their thread exits.
+// ============================================================================
+
+struct alignas(PLATFORM_CACHE_LINE_SIZE) FHazardSlot
+{
+	std::atomic<const void*> Snapshot{ nullptr };
+	std::atomic<bool> bInUse{ true };
+	FHazardSlot* Next = nullptr;
+};
+
+static std::atomic<FHazardSlot*> GHazardSlots{ nullptr };
+
+static FHazardSlot* ClaimHazardSlot()
+{
+	for (FHazardSlot* Slot = GHazardSlots.load(std::memory_order_acquire); Slot; Slot = Slot->Next)
+	{
+		bool bExpected = false;
+		if (!Slot->bInUse.load(std::memory_order_relaxed) && Slot->bInUse.compare_exchange_strong(bExpected, true))
+		{
+			return Slot;
+		}
+	}
+
+	FHazardSlot* Slot = new FHazardSlot();
+	FHazardSlot* Head = GHazardSlots.load(std::memory_order_relaxed);
+	do
+	{
+		Slot->Next = Head;
+	} while (!GHazardSlots.compare_exchange_weak(Head, Slot, std::memory_order_release, std::memory_order_relaxed));
+	return Slot;
+}
+
+// Hands the slot back for reuse when its thread exits
+struct FThreadHazardSlot
+{
+	FHazardSlot* Slot = ClaimHazardSlot();
+
+	~FThreadHazardSlot()
+	{
+		Slot->Snapshot.store(nullptr, std::memory_order_release);
+		Slot->bInUse.store(false, std::memory_order_release);
+	}
+};
+
+static FHazardSlot& GetThreadHazardSlot()
+{
+	thread_local FThreadHazardSlot ThreadSlot;
+	return *ThreadSlot.Slot;
+}
+
+// ============================================================================
+// REGISTRY
+// ============================================================================
+
+FCustomStackSizeRegistry::FCustomStackSizeRegistry()
+	: Current(nullptr)
+{
+	FScopeLock WriteLock(&WriterLock);
+
+	PublishLocked(FSnapshot());
+}
+
+bool FCustomStackSizeRegistry::Find(UClass* ItemClass, FCustomStackSizeRecord& OutRecord) const
+{
+	FHazardSlot& Slot = GetThreadHazardSlot();
+
+	// Announce the snapshot, then confirm it is still current so a writer cannot have freed it in between
+	const FSnapshot* Snapshot = Current.load(std::memory_order_acquire);
+	for (;;)
+	{
+		Slot.Snapshot.store(Snapshot, std::memory_order_seq_cst);
+		const FSnapshot* Confirmed = Current.load(std::memory_order_seq_cst);
+		if (Confirmed == Snapshot)
+			break;
+		Snapshot = Confirmed;
+	}
+
+	bool bFound = false;
+	if (const FCustomStackSizeRecord* Record = Snapshot->Find(ItemClass))
+	{
+		OutRecord = *Record;
+		bFound = true;
+	}
+
+	Slot.Snapshot.store(nullptr, std::memory_order_release);
+	return bFound;
+}
+
+FCustomStackSizeRegistry::FSnapshot FCustomStackSizeRegistry::Copy() const
+{
+	FScopeLock WriteLock(&WriterLock);
+
+	return *CurrentOwner;
+}
+
+void FCustomStackSizeRegistry::Add(UClass* ItemClass, const FCustomStackSizeRecord& Record)
+{
+	FScopeLock WriteLock(&WriterLock);
+
+	FSnapshot Next = *CurrentOwner;
+	Next.Add(ItemClass, Record);
+	PublishLocked(MoveTemp(Next));
+}
+
+void FCustomStackSizeRegistry::Append(const FSnapshot& Records)
+{
+	FScopeLock WriteLock(&WriterLock);
+
+	FSnapshot Next = *CurrentOwner;
+	Next.Append(Records);
+	PublishLocked(MoveTemp(Next));
+}
+
+void FCustomStackSizeRegistry::Remove(UClass* ItemClass)
+{
+	FScopeLock WriteLock(&WriterLock);
+
+	FSnapshot Next = *CurrentOwner;
+	if (Next.Remove(ItemClass) > 0)
+	{
+		PublishLocked(MoveTemp(Next));
+	}
+}
+
+void FCustomStackSizeRegistry::Publish(FSnapshot&& Snapshot)
+{
+	FScopeLock WriteLock(&WriterLock);
+
+	PublishLocked(MoveTemp(Snapshot));
+}
+
+void FCustomStackSizeRegistry::Reset()
+{
+	FScopeLock WriteLock(&WriterLock);
+
+	PublishLocked(FSnapshot());
+}
+
+int32 FCustomStackSizeRegistry::GetNumRetired() const
+{
+	FScopeLock WriteLock(&WriterLock);
+
+	return Retired.Num();
+}
+
+void FCustomStackSizeRegistry::PublishLocked(FSnapshot&& Snapshot)
+{
+	TUniquePtr<FSnapshot> Next = MakeUnique<FSnapshot>(MoveTemp(Snapshot));
+	Current.store(Next.Get(), std::memory_order_seq_cst);
+
+	if (CurrentOwner)
+	{
+		Retired.Add(MoveTemp(CurrentOwner));
+	}
+	CurrentOwner = MoveTemp(Next);
+
+	ReclaimLocked();
+}
+
+void FCustomStackSizeRegistry::ReclaimLocked()
+{
+	if (Retired.Num() == 0)
+		return;
+
+	TSet<const void*, DefaultKeyFuncs<const void*>, TInlineSetAllocator<16>> Hazards;
+	for (FHazardSlot* Slot = GHazardSlots.load(std::memory_order_acquire); Slot; Slot = Slot->Next)
+	{
+		if (const void* Snapshot = Slot->Snapshot.load(std::memory_order_seq_cst))
+		{
+			Hazards.Add(Snapshot);
+		}
+	}
+
+	Retired.RemoveAllSwap([&Hazards](const TUniquePtr<FSnapshot>& Snapshot)
+		{
+			return !Hazards.Contains(Snapshot.Get());
+		});
+}
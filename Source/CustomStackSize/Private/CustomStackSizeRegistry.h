@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Resources/FGItemDescriptor.h"
+#include <atomic>
+
+class UClass;
+
+// Size and form of one override; always read and published together
+struct FCustomStackSizeRecord
+{
+	int32 StackSize = 0;
+	EResourceForm Form = EResourceForm::RF_SOLID;
+};
+
+/**
+ * Stack size overrides, safe to read from any thread.
+ *
+ * Writers copy the current map, modify the copy and publish it as a new immutable snapshot.
+ * Readers load the current snapshot pointer and announce it in their own thread's hazard slot
+ * (a cache line no other thread writes), so a lookup never mixes two publishes and readers never
+ * contend with each other.
+ *
+ * After each publish the writer frees every retired snapshot that no hazard slot points at, so at
+ * most one retired snapshot per in-flight reader is kept alive.
+ */
+class FCustomStackSizeRegistry
+{
+public:
+	using FSnapshot = TMap<UClass*, FCustomStackSizeRecord>;
+
+	FCustomStackSizeRegistry();
+
+	bool Find(UClass* ItemClass, FCustomStackSizeRecord& OutRecord) const;
+
+	// Copy of the current snapshot, for callers that need to iterate it
+	FSnapshot Copy() const;
+
+	void Add(UClass* ItemClass, const FCustomStackSizeRecord& Record);
+	void Append(const FSnapshot& Records);
+	void Remove(UClass* ItemClass);
+	void Publish(FSnapshot&& Snapshot);
+	void Reset();
+
+	// Retired snapshots still waiting on a reader; exposed for the stress harness
+	int32 GetNumRetired() const;
+
+private:
+	// All of these require WriterLock to be held
+	void PublishLocked(FSnapshot&& Snapshot);
+	void ReclaimLocked();
+
+	std::atomic<const FSnapshot*> Current;
+
+	// Owner of Current; only replaced under WriterLock
+	TUniquePtr<FSnapshot> CurrentOwner;
+
+	// Replaced snapshots that a reader may still be inside
+	TArray<TUniquePtr<FSnapshot>> Retired;
+
+	// Serialises copy-modify-publish and reclamation
+	mutable FCriticalSection WriterLock;
+};
+
+/**
+ * Registry half of the GetStackSize hook, including the hook's per-call logging.
+ * Shared with the stress harness so it can measure the work the hook really does.
+ */
+bool FindHookedStackSize(const FCustomStackSizeRegistry& Registry, UObject* Context, UClass* ItemClass, FCustomStackSizeRecord& OutRecord);
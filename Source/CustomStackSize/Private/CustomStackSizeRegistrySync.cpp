@@ -0,0 +1,588 @@
+#include "CustomStackSizeRegistrySync.h"
+#include "CustomStackSize.h"
+#include "CustomStackSizeLog.h"
+#include "FGPlayerController.h"
+#include "Async/Async.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Hash/CityHash.h"
+#include "HAL/IConsoleManager.h"
+#include "Net/UnrealNetwork.h"
+#include "Containers/StringConv.h"
+#include <atomic>
+
+static constexpr uint32 RegistryMagic = 0x52535343; // "CSSR"
+static constexpr uint8 RegistryVersion = 1;
+static constexpr int32 RegistryHeaderSize = sizeof(uint32) + sizeof(uint8) + sizeof(uint64);
+
+// Server side, game thread only; bumped on every publish after startup
+static int32 GRegistryRevision = 1;
+
+// Set while a push to connected clients is queued, so a burst of registrations only pushes once
+static std::atomic<bool> GRegistryPushPending{ false };
+
+static TAutoConsoleVariable<bool> CVarForceRegistrySync(
+	TEXT("CustomStackSize.ForceRegistrySync"),
+	false,
+	TEXT("Ask the server for its full registry at login even when the hashes already match."));
+
+// ============================================================================
+// ENCODING HELPERS
+// ============================================================================
+
+static void WriteVarUInt(TArray<uint8>& Out, uint64 Value)
+{
+	do
+	{
+		uint8 Byte = Value & 0x7F;
+		Value >>= 7;
+		if (Value)
+			Byte |= 0x80;
+		Out.Add(Byte);
+	} while (Value);
+}
+
+static void WriteFixed(TArray<uint8>& Out, uint64 Value, int32 NumBytes)
+{
+	for (int32 i = 0; i < NumBytes; ++i)
+	{
+		Out.Add((uint8)(Value >> (8 * i)));
+	}
+}
+
+static uint64 ZigZagEncode(int64 Value)
+{
+	return ((uint64)Value << 1) ^ (uint64)(Value >> 63);
+}
+
+static int64 ZigZagDecode(uint64 Value)
+{
+	return (int64)(Value >> 1) ^ -(int64)(Value & 1);
+}
+
+struct FRegistryReader
+{
+	const uint8* Data;
+	int32 Num;
+	int32 Pos = 0;
+
+	int32 Remaining() const { return Num - Pos; }
+
+	bool ReadVarUInt(uint64& OutValue)
+	{
+		OutValue = 0;
+		for (int32 Shift = 0; Shift < 64; Shift += 7)
+		{
+			if (Pos >= Num)
+				return false;
+
+			const uint8 Byte = Data[Pos++];
+			OutValue |= (uint64)(Byte & 0x7F) << Shift;
+			if (!(Byte & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	bool ReadFixed(uint64& OutValue, int32 NumBytes)
+	{
+		if (Remaining() < NumBytes)
+			return false;
+
+		OutValue = 0;
+		for (int32 i = 0; i < NumBytes; ++i)
+		{
+			OutValue |= (uint64)Data[Pos++] << (8 * i);
+		}
+		return true;
+	}
+};
+
+struct FSortedEntry
+{
+	FString Path;
+	const FCustomStackSizeEntry* Entry;
+};
+
+static void SortByPath(const TArray<FCustomStackSizeEntry>& Entries, TArray<FSortedEntry>& OutSorted)
+{
+	OutSorted.Reset(Entries.Num());
+	for (const FCustomStackSizeEntry& Entry : Entries)
+	{
+		// Registration already rejects these; filtering here keeps the hash and encoder in line with the decoder
+		if (Entry.ItemClass && FCustomStackSizeModule::IsValidStackSize(Entry.StackSize, Entry.Form))
+		{
+			OutSorted.Add({ Entry.ItemClass->GetPathName(), &Entry });
+		}
+	}
+
+	OutSorted.Sort([](const FSortedEntry& A, const FSortedEntry& B)
+		{
+			return A.Path.Compare(B.Path, ESearchCase::CaseSensitive) < 0;
+		});
+}
+
+// ============================================================================
+// CODEC
+// ============================================================================
+
+uint64 FCustomStackSizeRegistryCodec::ComputeHash(const TArray<FCustomStackSizeEntry>& Entries)
+{
+	TArray<FSortedEntry> Sorted;
+	SortByPath(Entries, Sorted);
+
+	// Canonical absolute form: path bytes, terminator, size, form
+	TArray<uint8> Canonical;
+	for (const FSortedEntry& Item : Sorted)
+	{
+		FTCHARToUTF8 Utf8(*Item.Path);
+		Canonical.Append((const uint8*)Utf8.Get(), Utf8.Length());
+		Canonical.Add(0);
+		WriteFixed(Canonical, (uint32)Item.Entry->StackSize, sizeof(int32));
+		Canonical.Add((uint8)Item.Entry->Form);
+	}
+
+	return CityHash64((const char*)Canonical.GetData(), Canonical.Num());
+}
+
+void FCustomStackSizeRegistryCodec::Encode(const TArray<FCustomStackSizeEntry>& Entries, TArray<uint8>& OutPayload)
+{
+	TArray<FSortedEntry> Sorted;
+	SortByPath(Entries, Sorted);
+
+	if (Sorted.Num() != Entries.Num())
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Skipped %d invalid registry entries while encoding"), Entries.Num() - Sorted.Num());
+	}
+
+	OutPayload.Reset();
+	WriteFixed(OutPayload, RegistryMagic, sizeof(uint32));
+	OutPayload.Add(RegistryVersion);
+	WriteFixed(OutPayload, ComputeHash(Entries), sizeof(uint64));
+
+	WriteVarUInt(OutPayload, Sorted.Num());
+
+	TArray<uint8> PrevPath;
+	for (const FSortedEntry& Item : Sorted)
+	{
+		FTCHARToUTF8 Utf8(*Item.Path);
+		const uint8* PathBytes = (const uint8*)Utf8.Get();
+		const int32 PathLen = Utf8.Length();
+
+		// Front coding: class paths under the same package share long prefixes
+		int32 Shared = 0;
+		while (Shared < PathLen && Shared < PrevPath.Num() && PathBytes[Shared] == PrevPath[Shared])
+		{
+			++Shared;
+		}
+
+		WriteVarUInt(OutPayload, Shared);
+		WriteVarUInt(OutPayload, PathLen - Shared);
+		OutPayload.Append(PathBytes + Shared, PathLen - Shared);
+
+		UClass* ItemClass = Item.Entry->ItemClass;
+		const int64 SizeDelta = (int64)Item.Entry->StackSize - FCustomStackSizeModule::GetVanillaStackSize(ItemClass);
+		const bool bFormOverride = Item.Entry->Form != FCustomStackSizeModule::GetVanillaResourceForm(ItemClass);
+
+		WriteVarUInt(OutPayload, (ZigZagEncode(SizeDelta) << 1) | (bFormOverride ? 1 : 0));
+		if (bFormOverride)
+		{
+			OutPayload.Add((uint8)Item.Entry->Form);
+		}
+
+		PrevPath.Reset();
+		PrevPath.Append(PathBytes, PathLen);
+	}
+}
+
+bool FCustomStackSizeRegistryCodec::Decode(const TArray<uint8>& Payload, TArray<FCustomStackSizeEntry>& OutEntries)
+{
+	OutEntries.Reset();
+
+	FRegistryReader Reader{ Payload.GetData(), Payload.Num() };
+
+	uint64 Magic = 0;
+	uint64 Version = 0;
+	uint64 ExpectedHash = 0;
+	if (!Reader.ReadFixed(Magic, sizeof(uint32)) || !Reader.ReadFixed(Version, sizeof(uint8)) || !Reader.ReadFixed(ExpectedHash, sizeof(uint64)))
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry payload truncated (%d bytes)"), Payload.Num());
+		return false;
+	}
+
+	if (Magic != RegistryMagic || Version != RegistryVersion)
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry payload has unsupported magic %08x or version %d"), (uint32)Magic, (int32)Version);
+		return false;
+	}
+
+	uint64 Count = 0;
+	// Every record takes at least three bytes, which bounds the allocation below
+	if (!Reader.ReadVarUInt(Count) || Count > (uint64)Reader.Remaining() / 3)
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry payload has an invalid entry count"));
+		return false;
+	}
+
+	OutEntries.Reserve((int32)Count);
+
+	TArray<uint8> Path;
+	for (uint64 Index = 0; Index < Count; ++Index)
+	{
+		uint64 Shared = 0;
+		uint64 SuffixLen = 0;
+		if (!Reader.ReadVarUInt(Shared) || !Reader.ReadVarUInt(SuffixLen)
+			|| Shared > (uint64)Path.Num() || SuffixLen > (uint64)Reader.Remaining())
+		{
+			UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry payload has a malformed path at entry %d"), (int32)Index);
+			return false;
+		}
+
+		Path.SetNum((int32)Shared);
+		Path.Append(Reader.Data + Reader.Pos, (int32)SuffixLen);
+		Reader.Pos += (int32)SuffixLen;
+
+		uint64 SizeAndFlag = 0;
+		if (!Reader.ReadVarUInt(SizeAndFlag))
+		{
+			UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry payload truncated at entry %d"), (int32)Index);
+			return false;
+		}
+
+		uint64 Form = 0;
+		const bool bFormOverride = (SizeAndFlag & 1) != 0;
+		if (bFormOverride && !Reader.ReadFixed(Form, sizeof(uint8)))
+		{
+			UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry payload truncated at entry %d"), (int32)Index);
+			return false;
+		}
+
+		// The hash only proves the payload is self-consistent; values still have to be ones we can write into a CDO
+		if (bFormOverride && (Form <= (uint64)EResourceForm::RF_INVALID || Form >= (uint64)EResourceForm::RF_LAST))
+		{
+			UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry payload has an invalid form %d at entry %d"), (int32)Form, (int32)Index);
+			return false;
+		}
+
+		FUTF8ToTCHAR Converted((const ANSICHAR*)Path.GetData(), Path.Num());
+		const FString ClassPath(Converted.Length(), Converted.Get());
+
+		UClass* ItemClass = LoadObject<UClass>(nullptr, *ClassPath);
+		if (!ItemClass || !IsValid(ItemClass))
+		{
+			UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Server registry references a class missing on this client: %s"), *ClassPath);
+			return false;
+		}
+
+		const int64 SizeDelta = ZigZagDecode(SizeAndFlag >> 1);
+		const int64 StackSize = (SizeDelta < MIN_int32 || SizeDelta > MAX_int32) ? 0 : FCustomStackSizeModule::GetVanillaStackSize(ItemClass) + SizeDelta;
+		if (StackSize > MAX_int32 || !FCustomStackSizeModule::IsValidStackSize((int32)StackSize, EResourceForm::RF_SOLID))
+		{
+			UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry payload has an invalid stack size for %s"), *ClassPath);
+			return false;
+		}
+
+		FCustomStackSizeEntry& Entry = OutEntries.AddDefaulted_GetRef();
+		Entry.ItemClass = ItemClass;
+		Entry.StackSize = (int32)StackSize;
+		Entry.Form = bFormOverride ? (EResourceForm)Form : FCustomStackSizeModule::GetVanillaResourceForm(ItemClass);
+	}
+
+	if (Reader.Remaining() != 0)
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry payload has %d trailing bytes"), Reader.Remaining());
+		return false;
+	}
+
+	const uint64 ActualHash = ComputeHash(OutEntries);
+	if (ActualHash != ExpectedHash)
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry hash mismatch after decode (expected %016llx, got %016llx) - vanilla baselines differ?"),
+			ExpectedHash, ActualHash);
+		return false;
+	}
+
+	return true;
+}
+
+bool FCustomStackSizeRegistryCodec::SplitIntoChunks(const TArray<uint8>& Payload, TArray<TArray<uint8>>& OutChunks)
+{
+	OutChunks.Reset();
+
+	const int32 NumChunks = FMath::Max(1, FMath::DivideAndRoundUp(Payload.Num(), MaxChunkBytes));
+	if (NumChunks > MaxChunks)
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry payload of %d bytes needs %d chunks, limit is %d"),
+			Payload.Num(), NumChunks, MaxChunks);
+		return false;
+	}
+
+	for (int32 Offset = 0; Offset < Payload.Num(); Offset += MaxChunkBytes)
+	{
+		OutChunks.Emplace(Payload.GetData() + Offset, FMath::Min(MaxChunkBytes, Payload.Num() - Offset));
+	}
+	return true;
+}
+
+uint64 FCustomStackSizeRegistryCodec::ComputeLocalHash()
+{
+	TArray<FCustomStackSizeEntry> Entries;
+	FCustomStackSizeModule::GetRegisteredStackSizes(Entries);
+	return ComputeHash(Entries);
+}
+
+// ============================================================================
+// CHUNK ASSEMBLER
+// ============================================================================
+
+bool FCustomStackSizeRegistryChunkAssembler::AddChunk(uint32 InTransferId, int32 ChunkIndex, int32 InNumChunks, const TArray<uint8>& Chunk)
+{
+	if (ChunkIndex == 0)
+	{
+		Reset();
+
+		if (InNumChunks < 1 || InNumChunks > FCustomStackSizeRegistryCodec::MaxChunks)
+		{
+			UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry chunk count %d out of range"), InNumChunks);
+			return false;
+		}
+
+		TransferId = InTransferId;
+		NumChunks = InNumChunks;
+	}
+	else if (NumChunks == 0 || InTransferId != TransferId || InNumChunks != NumChunks || ChunkIndex != NextChunk)
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry chunk %d/%d of transfer %u out of sequence (expected %d/%d of transfer %u)"),
+			ChunkIndex, InNumChunks, InTransferId, NextChunk, NumChunks, TransferId);
+		Reset();
+		return false;
+	}
+
+	if (Chunk.Num() < 1 || Chunk.Num() > FCustomStackSizeRegistryCodec::MaxChunkBytes)
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry chunk %d of transfer %u has invalid size %d"),
+			ChunkIndex, InTransferId, Chunk.Num());
+		Reset();
+		return false;
+	}
+
+	Payload.Append(Chunk);
+	++NextChunk;
+	return true;
+}
+
+void FCustomStackSizeRegistryChunkAssembler::Reset()
+{
+	Payload.Reset();
+	TransferId = 0;
+	NumChunks = 0;
+	NextChunk = 0;
+}
+
+// Prints the local registry hash and payload size, to compare a listen server against a loopback client
+static FAutoConsoleCommand DumpRegistryCommand(
+	TEXT("CustomStackSize.DumpRegistry"),
+	TEXT("Log the local stack size registry hash, entry count and encoded payload size."),
+	FConsoleCommandDelegate::CreateStatic([]()
+		{
+			TArray<FCustomStackSizeEntry> Entries;
+			FCustomStackSizeModule::GetRegisteredStackSizes(Entries);
+
+			TArray<uint8> Payload;
+			FCustomStackSizeRegistryCodec::Encode(Entries, Payload);
+
+			UE_LOG(LogCustomStackSize, Display, TEXT("[CustomStackSize] Registry: %d entries, hash %016llx, %d bytes encoded"),
+				Entries.Num(), FCustomStackSizeRegistryCodec::ComputeHash(Entries), Payload.Num());
+		}));
+
+// ============================================================================
+// REMOTE CALL OBJECT
+// ============================================================================
+
+void UCustomStackSizeRegistrySync::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(UCustomStackSizeRegistrySync, mRegistryRevision, COND_OwnerOnly);
+}
+
+UCustomStackSizeRegistrySync* UCustomStackSizeRegistrySync::FindForPlayer(APlayerController* PlayerController)
+{
+	// The listen server host already uses the authoritative registry
+	if (!PlayerController || PlayerController->IsLocalController())
+		return nullptr;
+
+	AFGPlayerController* FGPlayerController = Cast<AFGPlayerController>(PlayerController);
+	if (!FGPlayerController)
+		return nullptr;
+
+	UCustomStackSizeRegistrySync* SyncObject = Cast<UCustomStackSizeRegistrySync>(
+		FGPlayerController->GetRemoteCallObjectOfClass(UCustomStackSizeRegistrySync::StaticClass()));
+	if (!SyncObject)
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] No registry sync object on %s"), *PlayerController->GetName());
+	}
+	return SyncObject;
+}
+
+void UCustomStackSizeRegistrySync::EnableHandshakeForPlayer(APlayerController* PlayerController)
+{
+	// Replicated state rather than an RPC: it reaches the client together with the object itself
+	if (UCustomStackSizeRegistrySync* SyncObject = FindForPlayer(PlayerController))
+	{
+		SyncObject->mRegistryRevision = GRegistryRevision;
+	}
+}
+
+void UCustomStackSizeRegistrySync::NotifyRegistryChanged()
+{
+	if (GRegistryPushPending.exchange(true))
+		return;
+
+	// Registrations may come from any thread; player controllers are only touched on the game thread
+	AsyncTask(ENamedThreads::GameThread, []()
+		{
+			GRegistryPushPending = false;
+			++GRegistryRevision;
+
+			if (!GEngine)
+				return;
+
+			int32 NumPushed = 0;
+			for (const FWorldContext& WorldContext : GEngine->GetWorldContexts())
+			{
+				UWorld* World = WorldContext.World();
+				if (!World || !World->IsGameWorld() || World->GetNetMode() == NM_Client || World->GetNetMode() == NM_Standalone)
+					continue;
+
+				for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+				{
+					UCustomStackSizeRegistrySync* SyncObject = FindForPlayer(It->Get());
+
+					// Players still logging in pick up the new revision at PostLogin
+					if (SyncObject && SyncObject->mRegistryRevision != 0)
+					{
+						SyncObject->mRegistryRevision = GRegistryRevision;
+						++NumPushed;
+					}
+				}
+			}
+
+			if (NumPushed > 0)
+			{
+				UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Registry changed, resyncing %d clients at revision %d"), NumPushed, GRegistryRevision);
+			}
+		});
+}
+
+void UCustomStackSizeRegistrySync::OnRep_RegistryRevision()
+{
+	if (mRegistryRevision == 0)
+		return;
+
+	// From here on local registrations wait for disconnect, so the hash offered below stays valid
+	FCustomStackSizeModule::BeginServerStackSizes();
+
+	const uint64 LocalHash = FCustomStackSizeRegistryCodec::ComputeLocalHash();
+	const bool bForceTransfer = CVarForceRegistrySync.GetValueOnGameThread();
+
+	UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Offering local registry hash %016llx to server at revision %d%s"),
+		LocalHash, mRegistryRevision, bForceTransfer ? TEXT(" (forced transfer)") : TEXT(""));
+
+	Server_OfferRegistryHash(mRegistryRevision, LocalHash, bForceTransfer);
+}
+
+void UCustomStackSizeRegistrySync::Server_OfferRegistryHash_Implementation(int32 Revision, uint64 ClientHash, bool bForceTransfer)
+{
+	// Each answer may cost a full transfer, so a client only gets one per revision the server handed out
+	if (mRegistryRevision == 0 || Revision != mRegistryRevision || Revision == mLastServedRevision)
+	{
+		// An offer for an older revision is expected while a newer one is replicating; anything else is not
+		if (mRegistryRevision != 0 && Revision < mRegistryRevision && Revision > mLastServedRevision)
+		{
+			UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Ignored stale registry offer from %s for revision %d (current %d)"),
+				*GetNameSafe(GetOuter()), Revision, mRegistryRevision);
+		}
+		else
+		{
+			UE_LOG(LogCustomStackSize, Warning, TEXT("[CustomStackSize] Rejected registry offer from %s for revision %d (current %d, last served %d)"),
+				*GetNameSafe(GetOuter()), Revision, mRegistryRevision, mLastServedRevision);
+		}
+		return;
+	}
+	mLastServedRevision = Revision;
+
+	TArray<FCustomStackSizeEntry> Entries;
+	FCustomStackSizeModule::GetRegisteredStackSizes(Entries);
+
+	const uint64 ServerHash = FCustomStackSizeRegistryCodec::ComputeHash(Entries);
+	if (ClientHash == ServerHash && !bForceTransfer)
+	{
+		UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Client registry already matches (%016llx), skipping transfer"), ServerHash);
+		Client_RegistryInSync(ServerHash);
+		return;
+	}
+
+	TArray<uint8> Payload;
+	FCustomStackSizeRegistryCodec::Encode(Entries, Payload);
+
+	TArray<TArray<uint8>> Chunks;
+	if (!FCustomStackSizeRegistryCodec::SplitIntoChunks(Payload, Chunks))
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Registry too large to send to %s, stack sizes will desync"),
+			*GetNameSafe(GetOuter()));
+		return;
+	}
+
+	const uint32 TransferId = mNextTransferId++;
+
+	UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Client registry differs (client %016llx, server %016llx), sending %d entries in %d bytes as %d chunks (transfer %u)"),
+		ClientHash, ServerHash, Entries.Num(), Payload.Num(), Chunks.Num(), TransferId);
+
+	for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+	{
+		Client_ReceiveRegistryChunk(TransferId, ChunkIndex, Chunks.Num(), Chunks[ChunkIndex]);
+	}
+}
+
+void UCustomStackSizeRegistrySync::Client_RegistryInSync_Implementation(uint64 ServerHash)
+{
+	const uint64 LocalHash = FCustomStackSizeRegistryCodec::ComputeLocalHash();
+	if (LocalHash != ServerHash)
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Server reported registry in sync at %016llx but local registry is %016llx, stack sizes may desync"),
+			ServerHash, LocalHash);
+		return;
+	}
+
+	UE_LOG(LogCustomStackSize, Log, TEXT("[CustomStackSize] Using server registry %016llx, local registrations deferred until disconnect"), ServerHash);
+}
+
+void UCustomStackSizeRegistrySync::Client_ReceiveRegistryChunk_Implementation(uint32 TransferId, int32 ChunkIndex, int32 NumChunks, const TArray<uint8>& Chunk)
+{
+	if (!mIncomingRegistry.AddChunk(TransferId, ChunkIndex, NumChunks, Chunk))
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Dropped server registry transfer %u, stack sizes may desync"), TransferId);
+		return;
+	}
+
+	if (!mIncomingRegistry.IsComplete())
+		return;
+
+	TArray<uint8> Payload = MoveTemp(mIncomingRegistry.Payload);
+	mIncomingRegistry.Reset();
+
+	// Decode verifies the hash over the reassembled payload
+	TArray<FCustomStackSizeEntry> Entries;
+	if (!FCustomStackSizeRegistryCodec::Decode(Payload, Entries))
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Rejected server registry, stack sizes may desync"));
+		return;
+	}
+
+	FCustomStackSizeModule::ApplyServerStackSizes(Entries);
+
+	UE_LOG(LogCustomStackSize, Warning, TEXT("[CustomStackSize] *** Applied server registry: %d entries, hash %016llx ***"),
+		Entries.Num(), FCustomStackSizeRegistryCodec::ComputeLocalHash());
+}
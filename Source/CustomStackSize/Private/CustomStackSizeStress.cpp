@@ -0,0 +1,270 @@
+#include "CustomStackSizeRegistry.h"
+#include "CustomStackSizeLog.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "UObject/Class.h"
+#include "UObject/UObjectIterator.h"
+#include <atomic>
+
+// ============================================================================
+// REGISTRY STRESS HARNESS
+//
+// Hammers a private FCustomStackSizeRegistry (the live one is untouched) with N reader threads
+// while one writer republishes records at a fixed rate through the same Add() path that
+// RegisterCustomStackSize uses. It runs two phases: raw Registry.Find(), then the GetStackSize
+// hook's own lookup (FindHookedStackSize) with its per-call logging, which is what production
+// pays; the hook numbers therefore depend on the LogCustomStackSize verbosity.
+//
+// Every record written in publish G has StackSize == G and a form derived from G, so a reader
+// seeing a size from one publish and a form from another is caught. Keys are never removed, so
+// a missing record is counted on its own.
+//
+// Retired snapshots are reclaimed after every publish; the writer line reports how many were
+// still pinned by readers at the end of the run.
+//
+// Unattended ThreadSanitizer run on Linux (a dedicated server needs no GPU):
+//
+//   Engine/Build/BatchFiles/Linux/Build.sh FactoryServer Linux Development -Project=<FactoryGame.uproject> -EnableTSan
+//   TSAN_OPTIONS="halt_on_error=1 exitcode=66" ./FactoryServer.sh -nullrhi -unattended -stdout \
+//       -ExecCmds="CustomStackSize.StressRegistry 8 1000 10 256 exit"
+//
+// With the trailing "exit" argument the process quits when the run finishes:
+//   0  every phase passed
+//   1  a reader saw a torn, stale or missing record
+//   66 ThreadSanitizer reported a race (halt_on_error aborts at the first report)
+// ============================================================================
+
+// Only time every Nth lookup so the clock read does not dominate the measured path
+static constexpr int32 ReadSampleInterval = 64;
+
+static EResourceForm FormForGeneration(int32 Generation)
+{
+	switch (Generation % 3)
+	{
+	case 0: return EResourceForm::RF_SOLID;
+	case 1: return EResourceForm::RF_LIQUID;
+	default: return EResourceForm::RF_GAS;
+	}
+}
+
+static double CyclesToNanoseconds(uint64 Cycles)
+{
+	return FPlatformTime::ToSeconds64(Cycles) * 1e9;
+}
+
+static double Percentile(TArray<uint64>& Samples, double Fraction)
+{
+	if (Samples.Num() == 0)
+		return 0.0;
+
+	Samples.Sort();
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * Samples.Num()) - 1, 0, Samples.Num() - 1);
+	return CyclesToNanoseconds(Samples[Index]);
+}
+
+// Registry reads the raw snapshot lookup; Hook goes through FindHookedStackSize, logging included
+enum class EStressReadPath : uint8
+{
+	Registry,
+	Hook
+};
+
+struct FStressReaderResult
+{
+	uint64 Lookups = 0;
+	uint64 TornRecords = 0;
+	uint64 StaleRecords = 0;
+	uint64 MissingRecords = 0;
+	TArray<uint64> LatencyCycles;
+};
+
+struct FStressPhaseResult
+{
+	FStressReaderResult Readers;
+	TArray<uint64> PublishCycles;
+	double Elapsed = 0.0;
+	int32 NumRetired = 0;
+};
+
+static FStressPhaseResult RunStressPhase(const TArray<UClass*>& Keys, int32 NumReaders, double PublishHz, double Seconds, EStressReadPath Path)
+{
+	FCustomStackSizeRegistry Registry;
+	{
+		FCustomStackSizeRegistry::FSnapshot Initial;
+		for (UClass* Key : Keys)
+		{
+			Initial.Add(Key, { 0, FormForGeneration(0) });
+		}
+		Registry.Publish(MoveTemp(Initial));
+	}
+
+	std::atomic<bool> bStop{ false };
+
+	TArray<TFuture<FStressReaderResult>> Readers;
+	for (int32 ReaderIndex = 0; ReaderIndex < NumReaders; ++ReaderIndex)
+	{
+		Readers.Add(Async(EAsyncExecution::Thread, [&Registry, &Keys, &bStop, ReaderIndex, Path]()
+			{
+				FStressReaderResult Result;
+				FRandomStream Random(ReaderIndex + 1);
+
+				// Publishes are monotonic per key, so a reader must never see a key go back in time
+				TArray<int32> LastSeen;
+				LastSeen.Init(0, Keys.Num());
+
+				while (!bStop.load(std::memory_order_relaxed))
+				{
+					const int32 KeyIndex = Random.RandHelper(Keys.Num());
+					UClass* Key = Keys[KeyIndex];
+					const bool bSample = (Result.Lookups % ReadSampleInterval) == 0;
+
+					const uint64 Start = bSample ? FPlatformTime::Cycles64() : 0;
+					FCustomStackSizeRecord Record;
+					const bool bFound = Path == EStressReadPath::Hook
+						? FindHookedStackSize(Registry, Key, Key, Record)
+						: Registry.Find(Key, Record);
+					if (bSample)
+					{
+						Result.LatencyCycles.Add(FPlatformTime::Cycles64() - Start);
+					}
+
+					++Result.Lookups;
+
+					if (!bFound)
+					{
+						++Result.MissingRecords;
+					}
+					else if (Record.Form != FormForGeneration(Record.StackSize))
+					{
+						++Result.TornRecords;
+					}
+					else if (Record.StackSize < LastSeen[KeyIndex])
+					{
+						++Result.StaleRecords;
+					}
+					else
+					{
+						LastSeen[KeyIndex] = Record.StackSize;
+					}
+				}
+				return Result;
+			}));
+	}
+
+	// Writer: one key per tick, round robin, through the same copy-modify-publish path as registration
+	FStressPhaseResult Phase;
+	const double Interval = 1.0 / PublishHz;
+	const double StartTime = FPlatformTime::Seconds();
+	int32 Generation = 0;
+
+	while (FPlatformTime::Seconds() - StartTime < Seconds)
+	{
+		const double TickStart = FPlatformTime::Seconds();
+
+		++Generation;
+		UClass* Key = Keys[Generation % Keys.Num()];
+
+		const uint64 Start = FPlatformTime::Cycles64();
+		Registry.Add(Key, { Generation, FormForGeneration(Generation) });
+		Phase.PublishCycles.Add(FPlatformTime::Cycles64() - Start);
+
+		const double Remaining = Interval - (FPlatformTime::Seconds() - TickStart);
+		if (Remaining > 0.0)
+		{
+			FPlatformProcess::Sleep((float)Remaining);
+		}
+	}
+
+	bStop.store(true, std::memory_order_relaxed);
+	Phase.Elapsed = FPlatformTime::Seconds() - StartTime;
+
+	for (TFuture<FStressReaderResult>& Reader : Readers)
+	{
+		FStressReaderResult Result = Reader.Get();
+		Phase.Readers.Lookups += Result.Lookups;
+		Phase.Readers.TornRecords += Result.TornRecords;
+		Phase.Readers.StaleRecords += Result.StaleRecords;
+		Phase.Readers.MissingRecords += Result.MissingRecords;
+		Phase.Readers.LatencyCycles.Append(MoveTemp(Result.LatencyCycles));
+	}
+
+	Phase.NumRetired = Registry.GetNumRetired();
+	return Phase;
+}
+
+// Returns false if any reader saw a torn, stale or missing record
+static bool ReportStressPhase(const TCHAR* Label, FStressPhaseResult& Phase)
+{
+	FStressReaderResult& Readers = Phase.Readers;
+
+	UE_LOG(LogCustomStackSize, Display, TEXT("[CustomStackSize] Stress %s readers: %.2f M lookups/s total, p50 %.0f ns, p99 %.0f ns"),
+		Label, Readers.Lookups / Phase.Elapsed / 1e6, Percentile(Readers.LatencyCycles, 0.50), Percentile(Readers.LatencyCycles, 0.99));
+	UE_LOG(LogCustomStackSize, Display, TEXT("[CustomStackSize] Stress %s writer: %d publishes (%.0f/s), p50 %.0f ns, p99 %.0f ns, max %.0f ns, %d snapshots still retired"),
+		Label, Phase.PublishCycles.Num(), Phase.PublishCycles.Num() / Phase.Elapsed,
+		Percentile(Phase.PublishCycles, 0.50), Percentile(Phase.PublishCycles, 0.99), Percentile(Phase.PublishCycles, 1.0), Phase.NumRetired);
+
+	if (Readers.TornRecords > 0 || Readers.StaleRecords > 0 || Readers.MissingRecords > 0)
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Stress %s FAILED: %llu torn, %llu stale and %llu missing records out of %llu lookups"),
+			Label, Readers.TornRecords, Readers.StaleRecords, Readers.MissingRecords, Readers.Lookups);
+		return false;
+	}
+
+	UE_LOG(LogCustomStackSize, Display, TEXT("[CustomStackSize] Stress %s passed: no torn, stale or missing records in %llu lookups"),
+		Label, Readers.Lookups);
+	return true;
+}
+
+static void RunRegistryStress(const TArray<FString>& InArgs)
+{
+	// "exit" may appear anywhere; the remaining arguments are positional
+	TArray<FString> Args = InArgs;
+	const bool bExitWhenDone = Args.RemoveAll([](const FString& Arg) { return Arg.Equals(TEXT("exit"), ESearchCase::IgnoreCase); }) > 0;
+
+	const int32 NumReaders = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 4;
+	const double PublishHz = Args.Num() > 1 ? FMath::Max(1.0, FCString::Atod(*Args[1])) : 1000.0;
+	const double Seconds = Args.Num() > 2 ? FMath::Max(0.1, FCString::Atod(*Args[2])) : 5.0;
+	const int32 RequestedEntries = Args.Num() > 3 ? FMath::Max(1, FCString::Atoi(*Args[3])) : 256;
+
+	// Real class pointers as keys, so hashing and map layout match the live registry
+	TArray<UClass*> Keys;
+	for (TObjectIterator<UClass> It; It && Keys.Num() < RequestedEntries; ++It)
+	{
+		Keys.Add(*It);
+	}
+
+	if (Keys.Num() == 0)
+	{
+		UE_LOG(LogCustomStackSize, Error, TEXT("[CustomStackSize] Stress: no classes available to use as keys"));
+		if (bExitWhenDone)
+		{
+			FPlatformMisc::RequestExitWithStatus(false, 1);
+		}
+		return;
+	}
+
+	UE_LOG(LogCustomStackSize, Display, TEXT("[CustomStackSize] Stress: %d readers, %.0f publishes/s, %.1fs per phase, %d entries"),
+		NumReaders, PublishHz, Seconds, Keys.Num());
+
+	FStressPhaseResult RegistryPhase = RunStressPhase(Keys, NumReaders, PublishHz, Seconds, EStressReadPath::Registry);
+	FStressPhaseResult HookPhase = RunStressPhase(Keys, NumReaders, PublishHz, Seconds, EStressReadPath::Hook);
+
+	const bool bRegistryPassed = ReportStressPhase(TEXT("registry"), RegistryPhase);
+	const bool bHookPassed = ReportStressPhase(TEXT("hook"), HookPhase);
+
+	ensureAlwaysMsgf(bRegistryPassed && bHookPassed, TEXT("Readers observed torn, stale or missing stack size records"));
+
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExitWithStatus(false, bRegistryPassed && bHookPassed ? 0 : 1);
+	}
+}
+
+static FAutoConsoleCommand StressRegistryCommand(
+	TEXT("CustomStackSize.StressRegistry"),
+	TEXT("Concurrent registry publish vs. lookup stress test. Args: [Readers=4] [PublishHz=1000] [Seconds=5] [Entries=256] [exit]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunRegistryStress));
@@ -0,0 +1,296 @@
+#include "CustomStackSizeRegistrySync.h"
+#include "CustomStackSize.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/UObjectIterator.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCustomStackSizeRegistryCodecTest, "CustomStackSize.RegistrySync.Codec",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+// Offset of the entry count varint: magic, version, hash
+static constexpr int32 CountOffset = sizeof(uint32) + sizeof(uint8) + sizeof(uint64);
+
+static void SortEntries(TArray<FCustomStackSizeEntry>& Entries)
+{
+	Entries.Sort([](const FCustomStackSizeEntry& A, const FCustomStackSizeEntry& B)
+		{
+			return A.ItemClass->GetPathName().Compare(B.ItemClass->GetPathName(), ESearchCase::CaseSensitive) < 0;
+		});
+}
+
+bool FCustomStackSizeRegistryCodecTest::RunTest(const FString& Parameters)
+{
+	// Malformed payloads below are expected to be logged as errors
+	AddExpectedError(TEXT("Registry payload"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	// Native classes so the test does not depend on content; /Script/CoreUObject.Class and .Object share a prefix
+	UClass* Descriptor = UFGItemDescriptor::StaticClass();
+	UClass* ObjectClass = UObject::StaticClass();
+	UClass* ClassClass = UClass::StaticClass();
+
+	TestTrue(TEXT("Descriptor vanilla size leaves room for a negative delta"), FCustomStackSizeModule::GetVanillaStackSize(Descriptor) > 1);
+
+	TArray<FCustomStackSizeEntry> Entries;
+	Entries.Add({ Descriptor, 1, EResourceForm::RF_GAS });                                               // negative delta, form override
+	Entries.Add({ ObjectClass, 5000, FCustomStackSizeModule::GetVanillaResourceForm(ObjectClass) });     // positive delta, vanilla form
+	Entries.Add({ ClassClass, 123456, EResourceForm::RF_LIQUID });                                       // multi-byte varint, form override
+
+	TArray<uint8> Payload;
+	FCustomStackSizeRegistryCodec::Encode(Entries, Payload);
+
+	// Round trip
+	{
+		TArray<FCustomStackSizeEntry> Decoded;
+		if (TestTrue(TEXT("Round trip decodes"), FCustomStackSizeRegistryCodec::Decode(Payload, Decoded))
+			&& TestEqual(TEXT("Round trip entry count"), Decoded.Num(), Entries.Num()))
+		{
+			TArray<FCustomStackSizeEntry> Expected = Entries;
+			SortEntries(Expected);
+			SortEntries(Decoded);
+
+			for (int32 i = 0; i < Expected.Num(); ++i)
+			{
+				TestTrue(TEXT("Round trip class"), Decoded[i].ItemClass == Expected[i].ItemClass);
+				TestEqual(TEXT("Round trip size"), Decoded[i].StackSize, Expected[i].StackSize);
+				TestEqual(TEXT("Round trip form"), (int32)Decoded[i].Form, (int32)Expected[i].Form);
+			}
+		}
+
+		TestTrue(TEXT("Hash is order independent"),
+			FCustomStackSizeRegistryCodec::ComputeHash(Decoded) == FCustomStackSizeRegistryCodec::ComputeHash(Entries));
+	}
+
+	// Truncated at every byte offset
+	for (int32 Length = 0; Length < Payload.Num(); ++Length)
+	{
+		TArray<uint8> Truncated(Payload.GetData(), Length);
+		TArray<FCustomStackSizeEntry> Decoded;
+		TestFalse(FString::Printf(TEXT("Payload truncated to %d bytes is rejected"), Length),
+			FCustomStackSizeRegistryCodec::Decode(Truncated, Decoded));
+	}
+
+	// Count claims more entries than the payload holds
+	TestTrue(TEXT("Entry count is a single byte varint"), Payload.Num() > CountOffset && Payload[CountOffset] == Entries.Num());
+	for (uint8 Count : { (uint8)(Entries.Num() + 1), (uint8)0x7F })
+	{
+		TArray<uint8> Overcounted = Payload;
+		Overcounted[CountOffset] = Count;
+		TArray<FCustomStackSizeEntry> Decoded;
+		TestFalse(FString::Printf(TEXT("Count of %d is rejected"), Count), FCustomStackSizeRegistryCodec::Decode(Overcounted, Decoded));
+	}
+
+	// Trailing bytes after the last entry
+	{
+		TArray<uint8> Trailing = Payload;
+		Trailing.Add(0);
+		TArray<FCustomStackSizeEntry> Decoded;
+		TestFalse(TEXT("Trailing bytes are rejected"), FCustomStackSizeRegistryCodec::Decode(Trailing, Decoded));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCustomStackSizeRegistryDecodeValidationTest, "CustomStackSize.RegistrySync.DecodeValidation",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+static void AppendVarUInt(TArray<uint8>& Out, uint64 Value)
+{
+	do
+	{
+		Out.Add((uint8)((Value & 0x7F) | (Value > 0x7F ? 0x80 : 0)));
+		Value >>= 7;
+	} while (Value);
+}
+
+static uint64 ZigZag(int64 Value)
+{
+	return ((uint64)Value << 1) ^ (uint64)(Value >> 63);
+}
+
+// Hand-built single entry payload, so fields the encoder never produces can be tested
+static TArray<uint8> BuildSingleEntryPayload(uint64 Hash, UClass* ItemClass, int64 SizeDelta, int32 FormByte)
+{
+	TArray<uint8> Payload;
+	for (int32 i = 0; i < 4; ++i)
+	{
+		Payload.Add((uint8)(0x52535343u >> (8 * i))); // "CSSR"
+	}
+	Payload.Add(1); // version
+	for (int32 i = 0; i < 8; ++i)
+	{
+		Payload.Add((uint8)(Hash >> (8 * i)));
+	}
+
+	AppendVarUInt(Payload, 1);
+
+	FTCHARToUTF8 Path(*ItemClass->GetPathName());
+	AppendVarUInt(Payload, 0);
+	AppendVarUInt(Payload, Path.Length());
+	Payload.Append((const uint8*)Path.Get(), Path.Length());
+
+	const bool bFormOverride = FormByte >= 0;
+	AppendVarUInt(Payload, (ZigZag(SizeDelta) << 1) | (bFormOverride ? 1 : 0));
+	if (bFormOverride)
+	{
+		Payload.Add((uint8)FormByte);
+	}
+	return Payload;
+}
+
+bool FCustomStackSizeRegistryDecodeValidationTest::RunTest(const FString& Parameters)
+{
+	AddExpectedError(TEXT("Registry payload"), EAutomationExpectedErrorFlags::Contains, 0);
+	AddExpectedError(TEXT("Registry hash mismatch"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	UClass* ObjectClass = UObject::StaticClass();
+	const int32 VanillaSize = FCustomStackSizeModule::GetVanillaStackSize(ObjectClass);
+
+	TArray<FCustomStackSizeEntry> Expected;
+	Expected.Add({ ObjectClass, VanillaSize + 4, EResourceForm::RF_LIQUID });
+	const uint64 Hash = FCustomStackSizeRegistryCodec::ComputeHash(Expected);
+
+	// Baseline: the hand-built layout matches the encoder
+	{
+		TArray<uint8> Encoded;
+		FCustomStackSizeRegistryCodec::Encode(Expected, Encoded);
+		const TArray<uint8> Payload = BuildSingleEntryPayload(Hash, ObjectClass, 4, (int32)EResourceForm::RF_LIQUID);
+		TestTrue(TEXT("Hand-built payload matches the encoder"), Payload == Encoded);
+
+		TArray<FCustomStackSizeEntry> Decoded;
+		TestTrue(TEXT("Hand-built payload decodes"), FCustomStackSizeRegistryCodec::Decode(Payload, Decoded));
+	}
+
+	// Form byte out of range
+	for (int32 FormByte : { (int32)EResourceForm::RF_INVALID, (int32)EResourceForm::RF_LAST, 255 })
+	{
+		TArray<FCustomStackSizeEntry> Decoded;
+		TestFalse(FString::Printf(TEXT("Form byte %d is rejected"), FormByte),
+			FCustomStackSizeRegistryCodec::Decode(BuildSingleEntryPayload(Hash, ObjectClass, 4, FormByte), Decoded));
+	}
+
+	// Size deltas that land below 1 or outside int32
+	const int64 BadDeltas[] = {
+		-(int64)VanillaSize,            // size 0
+		-(int64)VanillaSize - 1,        // negative size
+		(int64)MAX_int32,               // vanilla + MAX_int32 overflows
+		(int64)MIN_int32 - 1,           // delta itself outside int32
+		(int64)1 << 40,
+	};
+	for (int64 Delta : BadDeltas)
+	{
+		TArray<FCustomStackSizeEntry> Decoded;
+		TestFalse(FString::Printf(TEXT("Size delta %lld is rejected"), Delta),
+			FCustomStackSizeRegistryCodec::Decode(BuildSingleEntryPayload(Hash, ObjectClass, Delta, (int32)EResourceForm::RF_LIQUID), Decoded));
+	}
+
+	// Well-formed payloads whose contents no longer match the hash
+	{
+		TArray<FCustomStackSizeEntry> Decoded;
+		TestFalse(TEXT("Changed form byte fails the hash check"),
+			FCustomStackSizeRegistryCodec::Decode(BuildSingleEntryPayload(Hash, ObjectClass, 4, (int32)EResourceForm::RF_GAS), Decoded));
+		TestFalse(TEXT("Changed size fails the hash check"),
+			FCustomStackSizeRegistryCodec::Decode(BuildSingleEntryPayload(Hash, ObjectClass, 5, (int32)EResourceForm::RF_LIQUID), Decoded));
+		TestFalse(TEXT("Changed hash byte fails the hash check"),
+			FCustomStackSizeRegistryCodec::Decode(BuildSingleEntryPayload(Hash ^ 0x80, ObjectClass, 4, (int32)EResourceForm::RF_LIQUID), Decoded));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCustomStackSizeRegistryChunkTest, "CustomStackSize.RegistrySync.Chunking",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCustomStackSizeRegistryChunkTest::RunTest(const FString& Parameters)
+{
+	AddExpectedError(TEXT("Registry chunk"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	// A registry well past what one replicated array may hold, built from native classes so it needs no content
+	TArray<FCustomStackSizeEntry> Entries;
+	for (TObjectIterator<UClass> It; It && Entries.Num() < 1000; ++It)
+	{
+		UClass* Class = *It;
+		if (Class->HasAnyClassFlags(CLASS_Native) && !Class->HasAnyClassFlags(CLASS_Deprecated | CLASS_NewerVersionExists))
+		{
+			Entries.Add({ Class, 100 + Entries.Num(), FCustomStackSizeModule::GetVanillaResourceForm(Class) });
+		}
+	}
+
+	TArray<uint8> Payload;
+	FCustomStackSizeRegistryCodec::Encode(Entries, Payload);
+	if (!TestTrue(FString::Printf(TEXT("Payload of %d bytes exceeds net.MaxRepArraySize"), Payload.Num()), Payload.Num() > 2048))
+		return false;
+
+	TArray<TArray<uint8>> Chunks;
+	if (!TestTrue(TEXT("Payload splits"), FCustomStackSizeRegistryCodec::SplitIntoChunks(Payload, Chunks)))
+		return false;
+
+	if (!TestTrue(TEXT("Payload needs several chunks"), Chunks.Num() > 1))
+		return false;
+
+	for (const TArray<uint8>& Chunk : Chunks)
+	{
+		TestTrue(TEXT("Chunk fits in one RPC"), Chunk.Num() > 0 && Chunk.Num() <= FCustomStackSizeRegistryCodec::MaxChunkBytes);
+	}
+
+	// In order: reassembles and decodes to the same registry
+	{
+		FCustomStackSizeRegistryChunkAssembler Assembler;
+		for (int32 i = 0; i < Chunks.Num(); ++i)
+		{
+			TestTrue(TEXT("Chunk accepted"), Assembler.AddChunk(7, i, Chunks.Num(), Chunks[i]));
+			TestEqual(TEXT("Complete only after the last chunk"), Assembler.IsComplete(), i == Chunks.Num() - 1);
+		}
+
+		TestTrue(TEXT("Reassembled payload matches"), Assembler.Payload == Payload);
+
+		TArray<FCustomStackSizeEntry> Decoded;
+		if (TestTrue(TEXT("Reassembled payload decodes"), FCustomStackSizeRegistryCodec::Decode(Assembler.Payload, Decoded)))
+		{
+			TestEqual(TEXT("Decoded entry count"), Decoded.Num(), Entries.Num());
+			TestTrue(TEXT("Decoded hash matches"),
+				FCustomStackSizeRegistryCodec::ComputeHash(Decoded) == FCustomStackSizeRegistryCodec::ComputeHash(Entries));
+		}
+	}
+
+	// Skipped chunk
+	{
+		FCustomStackSizeRegistryChunkAssembler Assembler;
+		Assembler.AddChunk(7, 0, Chunks.Num(), Chunks[0]);
+		TestFalse(TEXT("Skipped chunk is rejected"), Assembler.AddChunk(7, 2, Chunks.Num(), Chunks[2 % Chunks.Num()]));
+		TestFalse(TEXT("Transfer is dropped"), Assembler.IsComplete());
+	}
+
+	// Chunk from another transfer
+	{
+		FCustomStackSizeRegistryChunkAssembler Assembler;
+		Assembler.AddChunk(7, 0, Chunks.Num(), Chunks[0]);
+		TestFalse(TEXT("Foreign transfer id is rejected"), Assembler.AddChunk(8, 1, Chunks.Num(), Chunks[1]));
+	}
+
+	// Continuation without a first chunk, bad counts and oversized chunks
+	{
+		FCustomStackSizeRegistryChunkAssembler Assembler;
+		TestFalse(TEXT("Continuation without a start is rejected"), Assembler.AddChunk(7, 1, Chunks.Num(), Chunks[1]));
+		TestFalse(TEXT("Zero chunk count is rejected"), Assembler.AddChunk(7, 0, 0, Chunks[0]));
+		TestFalse(TEXT("Chunk count above the limit is rejected"), Assembler.AddChunk(7, 0, FCustomStackSizeRegistryCodec::MaxChunks + 1, Chunks[0]));
+
+		TArray<uint8> Oversized;
+		Oversized.SetNumZeroed(FCustomStackSizeRegistryCodec::MaxChunkBytes + 1);
+		TestFalse(TEXT("Oversized chunk is rejected"), Assembler.AddChunk(7, 0, 1, Oversized));
+	}
+
+	// Payloads beyond the chunk limit fail to split instead of being truncated
+	{
+		AddExpectedError(TEXT("needs"), EAutomationExpectedErrorFlags::Contains, 1);
+
+		TArray<uint8> Huge;
+		Huge.SetNumZeroed(FCustomStackSizeRegistryCodec::MaxChunkBytes * FCustomStackSizeRegistryCodec::MaxChunks + 1);
+		TArray<TArray<uint8>> HugeChunks;
+		TestFalse(TEXT("Payload above the transfer limit is refused"), FCustomStackSizeRegistryCodec::SplitIntoChunks(Huge, HugeChunks));
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
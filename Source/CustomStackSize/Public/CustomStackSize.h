@@ -6,6 +6,14 @@
 
 class UClass;
 
+// One registered override, as exchanged between server and clients
+struct FCustomStackSizeEntry
+{
+	UClass* ItemClass = nullptr;
+	int32 StackSize = 0;
+	EResourceForm Form = EResourceForm::RF_SOLID;
+};
+
 class CUSTOMSTACKSIZE_API FCustomStackSizeModule : public IModuleInterface
 {
 public:
@@ -14,11 +22,32 @@ public:
 	virtual void ShutdownModule() override;
 	static void RegisterCustomStackSize(UClass* ItemClass, int32 StackSize, EResourceForm Form = EResourceForm::RF_SOLID);
 	static void RegisterCustomStackSize(const FString& ItemPath, int32 StackSize, EResourceForm Form = EResourceForm::RF_SOLID);
+
+	// Registers many items with a single registry publish; prefer this for startup registration of whole item sets
+	static void RegisterCustomStackSizes(const TArray<FCustomStackSizeEntry>& Entries);
 	static int32 GetCustomStackSize(UClass* ItemClass);
 
+	// Values the registry accepts; the same rule is applied on registration, encoding and decoding
+	static bool IsValidStackSize(int32 StackSize, EResourceForm Form);
+
+	// Registry snapshot used by the server -> client sync
+	static void GetRegisteredStackSizes(TArray<FCustomStackSizeEntry>& OutEntries);
+
+	// Clients switch to the server's registry while connected; local registrations are kept and restored on leave.
+	// BeginServerStackSizes defers local registrations from the start of the handshake, before any payload arrives.
+	static void BeginServerStackSizes();
+	static void ApplyServerStackSizes(const TArray<FCustomStackSizeEntry>& Entries);
+	static void RestoreLocalStackSizes();
+
+	// Unmodified game values, used as the shared baseline for delta encoding
+	static int32 GetVanillaStackSize(UClass* ItemClass);
+	static EResourceForm GetVanillaResourceForm(UClass* ItemClass);
+
 private:
 	void InitHooks();
 
 	FDelegateHandle PostEngineInitHandle;
 	FDelegateHandle WorldTickHandle;
+	FDelegateHandle PostLoginHandle;
+	FDelegateHandle WorldCleanupHandle;
 };
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FGRemoteCallObject.h"
+#include "CustomStackSize.h"
+#include "CustomStackSizeRegistrySync.generated.h"
+
+class APlayerController;
+
+/**
+ * Compact binary encoding of the stack size registry.
+ *
+ * Layout: magic, version, content hash, varint entry count, then one record per entry sorted by class path.
+ * Each path shares a prefix with the previous one; sizes are zigzag varints relative to the vanilla stack size,
+ * and the form byte is only written when it differs from the vanilla form.
+ * The hash covers the absolute (path, size, form) values, so a client decoding against a different baseline is caught.
+ */
+struct CUSTOMSTACKSIZE_API FCustomStackSizeRegistryCodec
+{
+	// Bytes per RPC; replicated arrays are capped by net.MaxRepArraySize (2048) and net.MaxRepArrayMemory
+	static constexpr int32 MaxChunkBytes = 1024;
+
+	// Chunks per transfer, so a whole transfer fits in the reliable RPC buffer
+	static constexpr int32 MaxChunks = 128;
+
+	static uint64 ComputeHash(const TArray<FCustomStackSizeEntry>& Entries);
+	static void Encode(const TArray<FCustomStackSizeEntry>& Entries, TArray<uint8>& OutPayload);
+	static bool Decode(const TArray<uint8>& Payload, TArray<FCustomStackSizeEntry>& OutEntries);
+
+	// Splits a payload into chunks of at most MaxChunkBytes; fails when it needs more than MaxChunks
+	static bool SplitIntoChunks(const TArray<uint8>& Payload, TArray<TArray<uint8>>& OutChunks);
+
+	// Hash of the registry currently active on this machine
+	static uint64 ComputeLocalHash();
+};
+
+/**
+ * Reassembles a chunked payload on the receiving side.
+ * Chunks must arrive in order and agree on the transfer id and chunk count; index 0 starts a new transfer.
+ * The payload's own hash is checked by Decode once the transfer is complete.
+ */
+struct CUSTOMSTACKSIZE_API FCustomStackSizeRegistryChunkAssembler
+{
+	// Returns false and drops the transfer when the chunk does not continue it
+	bool AddChunk(uint32 InTransferId, int32 ChunkIndex, int32 InNumChunks, const TArray<uint8>& Chunk);
+
+	bool IsComplete() const { return NumChunks > 0 && NextChunk == NumChunks; }
+
+	void Reset();
+
+	TArray<uint8> Payload;
+
+private:
+	uint32 TransferId = 0;
+	int32 NumChunks = 0;
+	int32 NextChunk = 0;
+};
+
+/**
+ * Per-player channel that brings a client's registry in line with the server's at login.
+ *
+ * The server sets a replicated registry revision at PostLogin, so it arrives with the object itself. Remote call
+ * objects are plain UObjects without BeginPlay; the RepNotify is the first point the object is live on the owning
+ * client. The client then defers its own registrations and offers its hash. The server answers with an in-sync ack
+ * when the hashes match, otherwise with the payload split into chunks that stay under the replicated array limits.
+ * Each later publish on the server bumps the revision, which runs the handshake again for every connected client.
+ */
+UCLASS()
+class CUSTOMSTACKSIZE_API UCustomStackSizeRegistrySync : public UFGRemoteCallObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// Called on the server from PostLogin
+	static void EnableHandshakeForPlayer(APlayerController* PlayerController);
+
+	// Called after every local publish; on a server this restarts the handshake for connected clients
+	static void NotifyRegistryChanged();
+
+	// Served once per revision; offers before PostLogin, for another revision or repeated ones are rejected
+	UFUNCTION(Server, Reliable)
+	void Server_OfferRegistryHash(int32 Revision, uint64 ClientHash, bool bForceTransfer);
+
+	UFUNCTION(Client, Reliable)
+	void Client_RegistryInSync(uint64 ServerHash);
+
+	UFUNCTION(Client, Reliable)
+	void Client_ReceiveRegistryChunk(uint32 TransferId, int32 ChunkIndex, int32 NumChunks, const TArray<uint8>& Chunk);
+
+private:
+	static UCustomStackSizeRegistrySync* FindForPlayer(APlayerController* PlayerController);
+
+	UFUNCTION()
+	void OnRep_RegistryRevision();
+
+	// Server registry revision to sync against, 0 until PostLogin.
+	// Also serves as the replicated property remote call objects need to be net addressable.
+	UPROPERTY(ReplicatedUsing = OnRep_RegistryRevision)
+	int32 mRegistryRevision = 0;
+
+	// Server: last revision this client was answered for
+	int32 mLastServedRevision = 0;
+
+	// Server: id of the next transfer to this client
+	uint32 mNextTransferId = 1;
+
+	// Client: transfer in progress
+	FCustomStackSizeRegistryChunkAssembler mIncomingRegistry;
+};